@@ -0,0 +1,36 @@
+//
+// .--.--.--------.-----.----.-----. vmacs text editor and more.
+// |  |  |        |  _  |  __|__ --| version 0.1.0
+//  \___/|__|__|__|__.__|____|_____| https://github.com/thakeenathees/vmacs
+//
+// Copyright (c) 2024 Thakee Nathees
+// Licenced under: MIT
+
+#pragma once
+
+#include "core/core.hpp"
+#include <chrono>
+
+
+// A micro benchmark is simply a function registered in the main.cpp with a name,
+// run it like: `bench <name>` or `bench` to run all of them.
+typedef void (*BenchFn)();
+
+
+// Measure the time it takes to run the given function in milliseconds.
+template <typename Fn>
+double BenchTime(Fn fn) {
+  auto start = std::chrono::steady_clock::now();
+  fn();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+
+// Returns a random generated source like text of the given size, with lines
+// of random lengths. Note that the seed is fixed so the results are comparable.
+std::vector<uint8_t> BenchGenerateText(size_t size);
+
+
+// Benchmarks.
+void BenchBuffer();
@@ -0,0 +1,77 @@
+//
+// .--.--.--------.-----.----.-----. vmacs text editor and more.
+// |  |  |        |  _  |  __|__ --| version 0.1.0
+//  \___/|__|__|__|__.__|____|_____| https://github.com/thakeenathees/vmacs
+//
+// Copyright (c) 2024 Thakee Nathees
+// Licenced under: MIT
+
+#include "bench.hpp"
+#include "document/document.hpp"
+
+
+// Compares the piece table against a flat std::vector<uint8_t> (what the Buffer
+// used to be) by typing and removing characters all over a large file.
+void BenchBuffer() {
+
+  const size_t file_size  = 50 * 1024 * 1024; // 50 MB.
+  const int edit_count    = 2000;
+  const int read_count    = 1000000;
+
+  std::vector<uint8_t> text = BenchGenerateText(file_size);
+
+  // Pre generate edit positions so both storages do the exact same thing.
+  // Every 20 edits we "move the cursor" to a random position and type there.
+  std::vector<size_t> positions;
+  {
+    uint32_t seed = 88172645;
+    size_t pos = 0;
+    for (int i = 0; i < edit_count; i++) {
+      if (i % 20 == 0) {
+        seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+        pos = seed % file_size;
+      }
+      positions.push_back(pos++);
+    }
+  }
+
+  const uint8_t ch = 'x';
+
+  std::vector<uint8_t> vec = text;
+  double vec_insert = BenchTime([&]() {
+    for (size_t pos : positions) vec.insert(vec.begin() + pos, ch);
+  });
+  double vec_remove = BenchTime([&]() {
+    for (auto it = positions.rbegin(); it != positions.rend(); ++it) {
+      vec.erase(vec.begin() + *it);
+    }
+  });
+
+  PieceTable table(std::move(text));
+  double table_insert = BenchTime([&]() {
+    for (size_t pos : positions) table.Insert(pos, &ch, 1);
+  });
+
+  // Sequential read of a region (what the renderer does for the visible lines).
+  volatile uint32_t sum = 0;
+  double vec_read = BenchTime([&]() {
+    for (int i = 0; i < read_count; i++) sum += vec[(file_size / 2) + i];
+  });
+  double table_read = BenchTime([&]() {
+    for (int i = 0; i < read_count; i++) sum += table.At((file_size / 2) + i);
+  });
+
+  double table_remove = BenchTime([&]() {
+    for (auto it = positions.rbegin(); it != positions.rend(); ++it) {
+      table.Remove(*it, 1);
+    }
+  });
+
+  printf("  file size      : %zu MB, %d edits, %d reads\n", file_size / (1024 * 1024), edit_count, read_count);
+  printf("  vector insert  : %10.3f ms (%8.3f us/op)\n", vec_insert, vec_insert * 1000 / edit_count);
+  printf("  vector remove  : %10.3f ms (%8.3f us/op)\n", vec_remove, vec_remove * 1000 / edit_count);
+  printf("  vector read    : %10.3f ms\n", vec_read);
+  printf("  piece insert   : %10.3f ms (%8.3f us/op)\n", table_insert, table_insert * 1000 / edit_count);
+  printf("  piece remove   : %10.3f ms (%8.3f us/op)\n", table_remove, table_remove * 1000 / edit_count);
+  printf("  piece read     : %10.3f ms\n", table_read);
+}
@@ -0,0 +1,53 @@
+//
+// .--.--.--------.-----.----.-----. vmacs text editor and more.
+// |  |  |        |  _  |  __|__ --| version 0.1.0
+//  \___/|__|__|__|__.__|____|_____| https://github.com/thakeenathees/vmacs
+//
+// Copyright (c) 2024 Thakee Nathees
+// Licenced under: MIT
+
+#include "bench.hpp"
+
+
+static const std::pair<const char*, BenchFn> benchmarks[] = {
+  { "buffer", BenchBuffer },
+};
+
+
+std::vector<uint8_t> BenchGenerateText(size_t size) {
+  std::vector<uint8_t> text(size);
+  uint32_t seed = 2463534242;
+  int line_length = 0;
+
+  for (size_t i = 0; i < size; i++) {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+
+    if (line_length > 0 && (seed % 60) == 0) {
+      text[i] = '\n';
+      line_length = 0;
+    } else {
+      text[i] = 'a' + (seed % 26);
+      line_length++;
+    }
+  }
+  return text;
+}
+
+
+int main(int argc, char** argv) {
+  bool found = false;
+  for (auto& [name, fn] : benchmarks) {
+    if (argc > 1 && strcmp(argv[1], name) != 0) continue;
+    printf("-- %s\n", name);
+    fn();
+    found = true;
+  }
+
+  if (!found) {
+    fprintf(stderr, "Benchmark \"%s\" not found.\n", argv[1]);
+    return 1;
+  }
+  return 0;
+}
@@ -80,3 +80,50 @@ project (project_name)
 postbuildcommands {
   -- "cp " .. root_dir_abs .. "/src/res/config.toml " .. bin_dir
 }
+
+
+-- ---------------------------------------------------------------------------
+-- Benchmarks
+-- ---------------------------------------------------------------------------
+
+-- Micro benchmarks are built as a separated binary with all the sources except
+-- the main.cpp, run: `bench [name]`.
+project "bench"
+  kind "ConsoleApp"
+  language "C++"
+  location (build_dir)
+  targetdir (build_dir .. "/bin/%{cfg.buildcfg}/bench")
+
+  filter "configurations:Debug"
+    defines { "DEBUG" }
+    symbols "On"
+
+  filter "configurations:Release"
+    defines { "NDEBUG" }
+    optimize "On"
+
+  filter {}
+
+  defines { "TB_OPT_ATTR_W=32" }
+  characterset ("ASCII")
+
+  files {
+    root_dir_rel .. "/bench/**.cpp",
+    root_dir_rel .. "/bench/**.hpp",
+    root_dir_rel .. "/src/**.c",
+    root_dir_rel .. "/src/**.cpp",
+    root_dir_rel .. "/thirdparty/termbox/*.c",
+    root_dir_rel .. "/thirdparty/tree-sitter-0.22.6/src/lib.c",
+  }
+
+  removefiles {
+    root_dir_rel .. "/src/main.cpp",
+  }
+
+  includedirs {
+    root_dir_rel .. "/src/",
+    root_dir_rel .. "/thirdparty/",
+    root_dir_rel .. "/thirdparty/termbox/",
+    root_dir_rel .. "/thirdparty/tree-sitter-0.22.6/include/",
+    root_dir_rel .. "/thirdparty/tree-sitter-0.22.6/src/",
+  }
@@ -14,45 +14,31 @@ Buffer::Buffer() : Buffer(std::vector<uint8_t>()) {
 }
 
 
-Buffer::Buffer(std::vector<uint8_t>&& data) : buffer(data) {
-  OnBufferChanged();
+Buffer::Buffer(std::vector<uint8_t>&& data) : text(std::move(data)) {
+  lines.ComputeLines(text);
 }
 
 
-const std::vector<Slice>& Lines::Get() const {
-  return slices;
+size_t Buffer::GetSize() const {
+  return text.GetSize();
 }
 
 
-void Lines::ComputeLines(const uint8_t* text, size_t size) {
-  slices.clear();
-
-  Slice slice;
-  slice.start = 0;
-
-  int i = 0;
-  while (i < size) {
-    if (text[i] == '\n') {
-      slice.end = i;
-      slices.push_back(slice);
-      slice.start = i + 1;
-    }
-    i++;
-  }
-  ASSERT(i == size, OOPS);
-
-  slice.end = i;
-  slices.push_back(slice);
+const uint8_t* Buffer::GetChunk(size_t index, size_t* length) const {
+  return text.GetChunk(index, length);
 }
 
 
-size_t Buffer::GetSize() const {
-  return buffer.size();
-}
-
+std::string Buffer::GetText() const {
+  std::string ret;
+  ret.reserve(text.GetSize());
 
-const uint8_t* Buffer::GetData() const {
-  return buffer.data();
+  size_t index = 0, length = 0;
+  while (const uint8_t* chunk = text.GetChunk(index, &length)) {
+    ret.append(reinterpret_cast<const char*>(chunk), length);
+    index += length;
+  }
+  return ret;
 }
 
 
@@ -60,69 +46,48 @@ uint32_t Buffer::At(size_t index) const {
 
   // Since the lines mimic a null terminated string and the last line's end index
   // is the size of the buffer, we should return a '\0'.
-  if (index == buffer.size()) return 0;
-  ASSERT_INDEX(index, buffer.size());
-
-  // Can't directly cast char to unit32_t since chars are signed and has negative
-  // values which will overflow the byte range if we directly cast.
-  return (uint8_t) buffer[index];
+  if (index == text.GetSize()) return 0;
+  ASSERT_INDEX(index, text.GetSize());
+  return text.At(index);
 }
 
 
 String Buffer::GetSubString(int index, int count) const {
   if (count == 0) return "";
-  ASSERT_INDEX(index, buffer.size());
-  ASSERT_INDEX(index + (count-1), buffer.size());
-  const char* cstr = reinterpret_cast<const char*>(buffer.data());
-  return String(std::string(cstr + index, count));
+  ASSERT_INDEX(index, text.GetSize());
+  ASSERT_INDEX(index + (count-1), text.GetSize());
+
+  std::string ret;
+  ret.reserve(count);
+  while (count > 0) {
+    size_t length;
+    const char* chunk = reinterpret_cast<const char*>(text.GetChunk(index, &length));
+    length = MIN(length, (size_t) count);
+    ret.append(chunk, length);
+    index += length;
+    count -= length;
+  }
+  return String(ret);
 }
 
 
 int Buffer::GetLineCount() const {
-  return (int) lines.Get().size();
+  return lines.GetCount();
 }
 
 
 Slice Buffer::GetLine(int index) const {
-  ASSERT_INDEX(index, lines.Get().size());
-  return lines.Get()[index];
+  ASSERT_INDEX(index, lines.GetCount());
+  return lines.Get(index);
 }
 
 
 Coord Buffer::IndexToCoord(size_t index) const {
-
-  const std::vector<Slice>& slices = lines.Get();
-  ASSERT(slices.size() >= 1, OOPS);
-
   // The index could also be equal the buffer size since the last line ends after
   // the buffer (we mimic null terminated string) and the cursor position will
-  // be equal to buffer.size(). That case also handled by the ComputeLines().
-  ASSERT_INDEX(index, buffer.size() + 1);
-  ASSERT(index != buffer.size() || index == slices[slices.size()-1].end, OOPS);
-
-  // Binary search in the lines array to find the index.
-  int start  = 0;
-  int end    = slices.size() - 1;
-  int middle = (start + end) / 2;
-
-  while (start <= end) {
-    const Slice& slice = slices[middle];
-    if (slice.start <= index && index <= slice.end) {
-      Coord coord;
-      coord.character = index - slice.start;
-      coord.line = middle;
-      return coord;
-
-    } else if (slice.end < index) {
-      start = middle + 1;
-
-    } else {
-      end = middle - 1;
-    }
-    middle = (start + end) / 2;
-  }
-
-  UNREACHABLE();
+  // be equal to buffer.size().
+  ASSERT_INDEX(index, text.GetSize() + 1);
+  return lines.IndexToCoord(index);
 }
 
 
@@ -150,7 +115,7 @@ int Buffer::IndexToColumn(size_t index) const {
 
 
 size_t Buffer::CoordToIndex(Coord coord) const {
-  return lines.Get()[coord.line].start + coord.character;
+  return lines.Get(coord.line).start + coord.character;
 }
 
 
@@ -196,7 +161,7 @@ bool Buffer::IsValidIndex(size_t index) const {
 bool Buffer::IsValidCoord(Coord coord, size_t* index) const {
   if (coord.line < 0) return false;
   if (coord.character < 0) return false;
-  if (coord.line >= lines.Get().size()) return false;
+  if (coord.line >= lines.GetCount()) return false;
   Slice line = GetLine(coord.line);
   int line_len = line.end - line.start + 1;
   if (coord.character >= line_len) return false;
@@ -206,27 +171,94 @@ bool Buffer::IsValidCoord(Coord coord, size_t* index) const {
 
 
 void Buffer::InsertText(size_t index, const String& text) {
-  ASSERT_INDEX(index, buffer.size() + 1);
-  auto begin = text.Data().begin();
-  auto end   = text.Data().end();
-  buffer.insert(buffer.begin() + index, begin, end);
+  ASSERT_INDEX(index, this->text.GetSize() + 1);
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(text.Data().data());
+  size_t length = text.Data().size();
+  if (length == 0) return;
+
+  BufferChange change;
+  change.start         = index;
+  change.old_end       = index;
+  change.new_end       = index + length;
+  change.start_coord   = IndexToCoord(index);
+  change.old_end_coord = change.start_coord;
+
+  lines.OnInsert(index, data, length);
+  this->text.Insert(index, data, length);
+
+  change.new_end_coord = IndexToCoord(change.new_end);
+  pending_changes.push_back(change);
   OnBufferChanged();
 }
 
 
 void Buffer::RemoveText(size_t index, int count) {
   if (count == 0) return;
-  ASSERT_INDEX(index, buffer.size());
-  ASSERT_INDEX(index + (count-1), buffer.size());
-  buffer.erase(buffer.begin() + index, buffer.begin() + index + count);
+  ASSERT_INDEX(index, text.GetSize());
+  ASSERT_INDEX(index + (count-1), text.GetSize());
+
+  BufferChange change;
+  change.start         = index;
+  change.old_end       = index + count;
+  change.new_end       = index;
+  change.start_coord   = IndexToCoord(index);
+  change.old_end_coord = IndexToCoord(change.old_end);
+  change.new_end_coord = change.start_coord;
+
+  lines.OnRemove(index, count);
+  text.Remove(index, count);
+
+  pending_changes.push_back(change);
+  OnBufferChanged();
+}
+
+
+std::vector<BufferChange> Buffer::ApplyEdits(const std::vector<Edit>& edits) {
+  std::vector<BufferChange> changes;
+  StartEdits();
+
+  for (const Edit& edit : edits) {
+    BufferChange change;
+    change.start         = edit.index;
+    change.old_end       = edit.index + edit.count;
+    change.new_end       = edit.index + edit.text.Data().size();
+    change.start_coord   = IndexToCoord(change.start);
+    change.old_end_coord = IndexToCoord(change.old_end);
+
+    RemoveText(edit.index, edit.count);
+    InsertText(edit.index, edit.text);
+
+    change.new_end_coord = IndexToCoord(change.new_end);
+    changes.push_back(change);
+  }
+
+  EndEdits();
+  return changes;
+}
+
+
+void Buffer::StartEdits() {
+  edits_depth++;
+}
+
+
+void Buffer::EndEdits() {
+  ASSERT(edits_depth > 0, OOPS);
+  edits_depth--;
   OnBufferChanged();
 }
 
 
 void Buffer::OnBufferChanged() {
-  lines.ComputeLines(buffer.data(), buffer.size());
+  if (edits_depth > 0) return;
+  if (pending_changes.empty()) return;
+
+  // Move the changes out first since a listener could modify the buffer again.
+  std::vector<BufferChange> changes = std::move(pending_changes);
+  pending_changes.clear();
+
   for (BufferListener* listener : listeners) {
-    listener->OnBufferChanged();
+    listener->OnBufferChanged(changes);
   }
 }
 
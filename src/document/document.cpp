@@ -168,10 +168,7 @@ void Document::SetLspClient(std::shared_ptr<LspClient> client) {
   if (language == nullptr) return; // TODO: Notify an error to the editor.
   lsp_client = client;
 
-  const char* cstr = reinterpret_cast<const char*>(buffer->GetData());
-
-  // The above pointer could be either nullptr or non-zero terminated string.
-  std::string text = (cstr != nullptr) ? std::string(cstr, buffer->GetSize()) : "";
+  std::string text = buffer->GetText();
   lsp_client->DidOpen(path, std::move(text), language->id, history.GetVersion());
 }
 
@@ -258,8 +255,9 @@ void Document::OnHistoryChanged(const std::vector<DocumentChange>& changes) {
 }
 
 
-void Document::OnBufferChanged() {
+void Document::OnBufferChanged(const std::vector<BufferChange>& changes) {
   const Theme* theme = get_theme ? get_theme() : nullptr;
+  syntax.Edit(changes);
   syntax.Parse(language.get(), buffer.get(), theme);
   OnDocumentChanged();
 }
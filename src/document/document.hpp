@@ -13,9 +13,35 @@
 #include <tree_sitter/api.h>
 
 
+// A single modification to apply on the buffer with Buffer::ApplyEdits(). It'll
+// remove count bytes at the index and then insert the text at the same index.
+// Note that the edits are applied in order so the index of an edit should be
+// relative to the buffer after all the previous edits are applied.
+struct Edit {
+  size_t index = 0;
+  size_t count = 0; // Number of bytes to remove.
+  String text;      // Text to insert (after the removal).
+};
+
+
+// The range of the buffer that was changed by a single insert/remove, reported
+// to the buffer listeners. The coordinates are in bytes (not the visual column)
+// and both the old and new end is reported so the listeners (ex: tree-sitter)
+// can shift whatever comes after the change.
+struct BufferChange {
+  size_t start   = 0; // Start index of the change.
+  size_t old_end = 0; // End index of the removed text (before the change).
+  size_t new_end = 0; // End index of the inserted text (after the change).
+  Coord start_coord;
+  Coord old_end_coord;
+  Coord new_end_coord;
+};
+
+
 class BufferListener {
 public:
-  virtual void OnBufferChanged() = 0;
+  // The changes are in the same order they were applied to the buffer.
+  virtual void OnBufferChanged(const std::vector<BufferChange>& changes) = 0;
   virtual ~BufferListener() = default;
 };
 
@@ -41,6 +67,90 @@ public:
 typedef const Theme* (*GetThemeFn)();
 
 
+// The text storage of a buffer. The file content is loaded into a read only
+// "original" buffer and every inserted text is appended to an "add" buffer,
+// none of them will ever be modified or moved after that. The document is
+// described as an ordered sequence of pieces, where each piece is a slice of
+// either of the buffers.
+//
+//   original = "hello world"
+//   add      = "big "
+//
+//   pieces   = { (original, 0, 6), (add, 0, 4), (original, 6, 5) }
+//   text     = "hello " + "big " + "world"
+//
+// The pieces are stored in a balanced binary tree (treap) ordered by their
+// position in the document and each node keeps the total bytes of it's
+// subtree, so locating an index, inserting and removing are all O(log pieces)
+// regardless of the size of the file.
+class PieceTable {
+
+public:
+  PieceTable();
+  PieceTable(std::vector<uint8_t>&& original);
+  ~PieceTable();
+
+  NO_COPY_CONSTRUCTOR(PieceTable);
+
+  size_t GetSize() const;
+  uint8_t At(size_t index) const;
+
+  // Returns a pointer to the contiguous bytes starting at the given index till
+  // the end of the piece it belongs to, and set the length to the number of
+  // bytes available. If the index is the end of the text it'll return nullptr.
+  // Note that the pointer is only valid till the next modification.
+  const uint8_t* GetChunk(size_t index, size_t* length) const;
+
+  void Insert(size_t index, const uint8_t* data, size_t length);
+  void Remove(size_t index, size_t count);
+
+private:
+  struct Piece {
+    bool added;    // If true it's a slice of the add buffer, otherwise original.
+    size_t start;  // Start index in the source buffer.
+    size_t length; // Number of bytes of this piece.
+  };
+
+  struct Node {
+    Piece piece;
+    uint32_t priority;  // Treap heap priority, parent's priority is always larger.
+    size_t size;        // Total number of bytes of this subtree.
+    std::unique_ptr<Node> left;
+    std::unique_ptr<Node> right;
+  };
+
+  std::vector<uint8_t> original; // Read only, the content of the file.
+  std::vector<uint8_t> add;      // Append only, all the inserted texts.
+  std::unique_ptr<Node> root;
+
+  // Random state to generate the treap priorities (xorshift32).
+  uint32_t seed = 2463534242;
+
+  // Most of the access are sequential (drawing the buffer, searching, etc) so
+  // we cache the last piece we've found and check it before the tree lookup.
+  // The cache will be cleared after any modification.
+  mutable size_t cache_index  = 0; // The document index where the piece starts.
+  mutable size_t cache_length = 0;
+  mutable const uint8_t* cache_data = nullptr;
+
+private:
+  const uint8_t* PieceData(const Piece& piece) const;
+  std::unique_ptr<Node> NewNode(const Piece& piece);
+
+  // Treap primitives, split the tree into [0, pos) and [pos, size) and merge
+  // two trees where all the bytes of the left comes before right.
+  static void Split(std::unique_ptr<Node> node, size_t pos,
+                    std::unique_ptr<Node>& left, std::unique_ptr<Node>& right);
+  static std::unique_ptr<Node> Merge(std::unique_ptr<Node> left, std::unique_ptr<Node> right);
+  static void UpdateSize(Node* node);
+
+  // If the last piece of the tree is the tail of the add buffer, we extend that
+  // piece instead of creating a new one (consecutive typing), returns true if
+  // it's extended.
+  static bool ExtendLast(Node* node, size_t add_start, size_t length);
+};
+
+
 // text    = "hello\nworld"
 // buffer  = {"h", "e", "l", "l", "o", "\n", "w", "o", "r", "l", "d", "\0"}
 // indexes =   0    1    2    3    4     5    6    7    8    9    10    11
@@ -63,14 +173,65 @@ typedef const Theme* (*GetThemeFn)();
 // open a new file on a text editor the very first line exists but there isn't
 // anything in the file buffer.
 //
+// Internally we don't store the slices but the length of each line (including
+// the new line character if it's not the last line) in a balanced binary tree
+// (treap) ordered by the line number, each node keeps the number of lines and
+// bytes of it's subtree. So that finding a line by it's number or by an index
+// is O(log n) and after an edit we only scan the inserted text, update the
+// effected lines and the rest of the lines are "shifted" by the subtree sums.
 class Lines {
 
 public:
-  void ComputeLines(const uint8_t* text, size_t size);
-  const std::vector<Slice>& Get() const;
+  Lines();
+  ~Lines();
+
+  NO_COPY_CONSTRUCTOR(Lines);
+
+  // Compute all the lines from the scratch, this should be called only once
+  // after the text is loaded.
+  void ComputeLines(const PieceTable& text);
+
+  int GetCount() const;
+  Slice Get(int line) const;
+  Coord IndexToCoord(size_t index) const;
+
+  // Update the lines before or after the text is modified (doesn't matter since
+  // it doesn't need the text).
+  void OnInsert(size_t index, const uint8_t* data, size_t length);
+  void OnRemove(size_t index, size_t count);
+
+private:
+  struct Node {
+    uint32_t length;   // Length of the line including the new line character.
+    uint32_t priority; // Treap heap priority, parent's priority is always larger.
+    uint32_t count;    // Number of lines of this subtree.
+    size_t bytes;      // Total number of bytes of this subtree.
+    std::unique_ptr<Node> left;
+    std::unique_ptr<Node> right;
+  };
+
+  std::unique_ptr<Node> root;
+
+  // Random state to generate the treap priorities (xorshift32).
+  uint32_t seed = 2463534242;
 
 private:
-  std::vector<Slice> slices = { {0, 0} };
+  std::unique_ptr<Node> NewNode(uint32_t length);
+
+  // Build a treap of the given line lengths in linear time (cartesian tree).
+  std::unique_ptr<Node> BuildTree(const std::vector<uint32_t>& lengths);
+
+  // Treap primitives, split the tree into lines [0, pos) and [pos, count) and
+  // merge two trees where all the lines of the left comes before right.
+  static void Split(std::unique_ptr<Node> node, uint32_t pos,
+                    std::unique_ptr<Node>& left, std::unique_ptr<Node>& right);
+  static std::unique_ptr<Node> Merge(std::unique_ptr<Node> left, std::unique_ptr<Node> right);
+  static void Update(Node* node);
+  static void UpdateAll(Node* node);
+
+  // Returns the length of the given line and change it by delta.
+  static uint32_t GetLength(const Node* node, uint32_t line);
+  static void AddLength(Node* node, uint32_t line, int64_t delta);
 };
 
 
@@ -81,10 +242,16 @@ public:
   Buffer(std::vector<uint8_t>&& data);
 
   size_t GetSize() const;
-  const uint8_t* GetData() const; // Returns nullptr if it's empty.
   uint32_t At(size_t index) const; // Returns the codepoint at the index.
   String GetSubString(int index, int count) const;
 
+  // The buffer is not contiguous in memory, Use this to read the buffer chunk
+  // by chunk (see PieceTable::GetChunk()). Returns nullptr at the end.
+  const uint8_t* GetChunk(size_t index, size_t* length) const;
+
+  // Returns a copy of the entire buffer as a contiguous string.
+  std::string GetText() const;
+
   int GetLineCount() const;
   Slice GetLine(int index) const;
 
@@ -104,17 +271,39 @@ public:
   void InsertText(size_t index, const String& text);
   void RemoveText(size_t index, int count);
 
+  // Apply all the edits in order and notify the listeners only once with all
+  // the changes. Returns the changes, one for each edit (in the same order).
+  std::vector<BufferChange> ApplyEdits(const std::vector<Edit>& edits);
+
+  // Between these calls all the modifications are grouped and the listeners are
+  // notified once at the end, instead of after every single insert/remove (ex:
+  // typing with hundreds of cursors). The calls can be nested.
+  //
+  // Example:
+  //   StartEdits();
+  //   for (cursor : cursors) InsertText(cursor.index, text);
+  //   EndEdits();
+  //
+  void StartEdits();
+  void EndEdits();
+
   // Buffer listener methods.
   void RegisterListener(BufferListener* listener);
   void UnRegisterListener(BufferListener* listener);
 
 private:
-  std::vector<uint8_t> buffer;
+  PieceTable text;
   Lines lines;
   std::vector<BufferListener*> listeners;
 
+  // The depth of the nested StartEdits() calls and the changes that are not
+  // reported to the listeners yet.
+  int edits_depth = 0;
+  std::vector<BufferChange> pending_changes;
+
 private:
-  // This should be called by every time the buffer is modified.
+  // This should be called by every time the buffer is modified, it'll notify
+  // the listeners if we're not inside an edit group.
   void OnBufferChanged();
 };
 
@@ -330,6 +519,10 @@ private:
   // action.
   Action& _GetListeningAction(const MultiCursor& cursor);
 
+  // Apply the edits to the buffer at once (used by undo/redo) and returns the
+  // lsp changes of the edits.
+  std::vector<DocumentChange> _ApplyEdits(const std::vector<Edit>& edits);
+
   // Listeners for the history.
   std::vector<HistoryListener*> listeners;
 
@@ -397,6 +590,11 @@ public:
   void Parse(const Language* language, const Buffer* buffer, const Theme* theme);
   const std::vector<Style>& GetHighlights() const;
 
+  // Edit the current syntax tree with the changes of the buffer, this should be
+  // called before Parse() (after the buffer is changed) to make the parsing
+  // incremental.
+  void Edit(const std::vector<BufferChange>& changes);
+
 private:
   TSParser* parser = NULL;
   TSTree* tree     = NULL;
@@ -483,7 +681,7 @@ public:
 
   // Listener super class implementation.
   void OnHistoryChanged(const std::vector<DocumentChange>& changes) override;
-  void OnBufferChanged() override;
+  void OnBufferChanged(const std::vector<BufferChange>& changes) override;
 
   // Cursor actions.
   void CursorRight();
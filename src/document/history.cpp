@@ -82,6 +82,10 @@ MultiCursor History::CommitInsertText(const MultiCursor& cursors_, const String&
 
   std::vector<DocumentChange> lsp_changes; // Required to send to lsp server.
 
+  // Group all the buffer changes of every cursor so the buffer listeners (the
+  // syntax highlighter) will only be notified once.
+  buffer->StartEdits();
+
   std::vector<Cursor>& curslist = cursors.Get();
   for (int i = 0; i  < curslist.size(); i++) {
     Cursor& cursor = curslist[i];
@@ -160,6 +164,8 @@ MultiCursor History::CommitInsertText(const MultiCursor& cursors_, const String&
     }
   }
 
+  buffer->EndEdits();
+
   // Sort and merge cursors if required.
   cursors.Changed();
 
@@ -187,6 +193,9 @@ MultiCursor History::CommitRemoveText(const MultiCursor& cursors_, int direction
 
   std::vector<DocumentChange> lsp_changes; // Required to send to lsp server.
 
+  // Group all the buffer changes of every cursor (see CommitInsertText()).
+  buffer->StartEdits();
+
   std::vector<Cursor>& curslist = cursors.Get();
   for (int i = 0; i < curslist.size(); i++) {
     Cursor& cursor = curslist[i];
@@ -275,6 +284,8 @@ MultiCursor History::CommitRemoveText(const MultiCursor& cursors_, int direction
     }
   } // Each cursor loop.
 
+  buffer->EndEdits();
+
   // We backspace/delet into nothing and there is no changes. Just return.
   if (!history_changed) return cursors;
 
@@ -303,27 +314,23 @@ bool History::HasRedo() const {
 const MultiCursor& History::Undo() {
   ASSERT(HasUndo(), OOPS);
   const Action& action = actions[--ptr];
-  std::vector<DocumentChange> lsp_changes;
 
+  // Revert the changes in the reverse order.
+  std::vector<Edit> edits;
   for (int i = action.changes.size() -1; i >= 0; i--) {
     const Change& change = action.changes[i];
-    DocumentChange lsp_change;
-
+    Edit edit;
+    edit.index = change.index;
     if (change.added) {
       ASSERT(change.text == buffer->GetSubString(change.index, change.text.Length()), OOPS);
-      lsp_change.start = buffer->IndexToCoord(change.index);
-      lsp_change.end   = buffer->IndexToCoord(change.index + change.text.Length());
-      lsp_change.text  = "";
-      lsp_changes.push_back(lsp_change);
-      buffer->RemoveText(change.index, change.text.Length());
+      edit.count = change.text.Length();
     } else {
-      lsp_change.start = buffer->IndexToCoord(change.index);
-      lsp_change.end   = lsp_change.start;
-      lsp_change.text  = change.text.Data();
-      lsp_changes.push_back(lsp_change);
-      buffer->InsertText(change.index, change.text);
+      edit.text = change.text;
     }
+    edits.push_back(std::move(edit));
   }
+
+  std::vector<DocumentChange> lsp_changes = _ApplyEdits(edits);
   version++;
 
   EndAction();
@@ -336,25 +343,21 @@ const MultiCursor& History::Undo() {
 const MultiCursor& History::Redo() {
   ASSERT(HasRedo(), OOPS);
   const Action& action = actions[ptr++];
-  std::vector<DocumentChange> lsp_changes;
 
+  std::vector<Edit> edits;
   for (const Change& change : action.changes) {
-    DocumentChange lsp_change;
+    Edit edit;
+    edit.index = change.index;
     if (change.added) {
-      lsp_change.start = buffer->IndexToCoord(change.index);
-      lsp_change.end   = lsp_change.start;
-      lsp_change.text  = change.text.Data();
-      lsp_changes.push_back(lsp_change);
-      buffer->InsertText(change.index, change.text);
+      edit.text = change.text;
     } else {
       ASSERT(change.text == buffer->GetSubString(change.index, change.text.Length()), OOPS);
-      lsp_change.start = buffer->IndexToCoord(change.index);
-      lsp_change.end   = buffer->IndexToCoord(change.index + change.text.Length());
-      lsp_change.text  = "";
-      lsp_changes.push_back(lsp_change);
-      buffer->RemoveText(change.index, change.text.Length());
+      edit.count = change.text.Length();
     }
+    edits.push_back(std::move(edit));
   }
+
+  std::vector<DocumentChange> lsp_changes = _ApplyEdits(edits);
   version++;
 
   EndAction();
@@ -364,6 +367,22 @@ const MultiCursor& History::Redo() {
 }
 
 
+std::vector<DocumentChange> History::_ApplyEdits(const std::vector<Edit>& edits) {
+  std::vector<BufferChange> changes = buffer->ApplyEdits(edits);
+  ASSERT(changes.size() == edits.size(), OOPS);
+
+  std::vector<DocumentChange> lsp_changes;
+  for (int i = 0; i < (int) edits.size(); i++) {
+    DocumentChange lsp_change;
+    lsp_change.start = changes[i].start_coord;
+    lsp_change.end   = changes[i].old_end_coord;
+    lsp_change.text  = edits[i].text.Data();
+    lsp_changes.push_back(lsp_change);
+  }
+  return lsp_changes;
+}
+
+
 Action& History::_GetListeningAction(const MultiCursor& cursors) {
 
   if (!listening_action) {
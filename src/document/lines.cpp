@@ -0,0 +1,340 @@
+//
+// .--.--.--------.-----.----.-----. vmacs text editor and more.
+// |  |  |        |  _  |  __|__ --| version 0.1.0
+//  \___/|__|__|__|__.__|____|_____| https://github.com/thakeenathees/vmacs
+//
+// Copyright (c) 2024 Thakee Nathees
+// Licenced under: MIT
+
+#include "core/core.hpp"
+#include "document.hpp"
+
+
+#define NODE_COUNT(node) ((node) ? (node)->count : 0)
+#define NODE_BYTES(node) ((node) ? (node)->bytes : 0)
+
+
+Lines::Lines() {
+  root = NewNode(0); // The "null line".
+}
+
+
+Lines::~Lines() {
+}
+
+
+void Lines::ComputeLines(const PieceTable& text) {
+
+  std::vector<uint32_t> lengths;
+  uint32_t length = 0;
+
+  size_t size = text.GetSize();
+  size_t i = 0;
+  while (i < size) {
+    size_t chunk_length;
+    const uint8_t* chunk = text.GetChunk(i, &chunk_length);
+    for (size_t j = 0; j < chunk_length; j++, i++) {
+      length++;
+      if (chunk[j] == '\n') {
+        lengths.push_back(length);
+        length = 0;
+      }
+    }
+  }
+  ASSERT(i == size, OOPS);
+
+  // The last line (without the new line character).
+  lengths.push_back(length);
+  root = BuildTree(lengths);
+}
+
+
+int Lines::GetCount() const {
+  return (int) NODE_COUNT(root);
+}
+
+
+Slice Lines::Get(int line) const {
+  ASSERT_INDEX(line, GetCount());
+
+  // The start index of the current subtree.
+  size_t start = 0;
+  uint32_t pos = (uint32_t) line;
+
+  const Node* node = root.get();
+  while (node != nullptr) {
+    uint32_t left_count = NODE_COUNT(node->left);
+
+    if (pos < left_count) {
+      node = node->left.get();
+
+    } else if (pos == left_count) {
+      start += NODE_BYTES(node->left);
+
+      // Every line except the last one ends with a new line character and the
+      // end index of the slice is the index of that new line character.
+      bool is_last = (line == GetCount() - 1);
+      size_t end = start + node->length - (is_last ? 0 : 1);
+      return Slice((int) start, (int) end);
+
+    } else {
+      start += NODE_BYTES(node->left) + node->length;
+      pos   -= left_count + 1;
+      node = node->right.get();
+    }
+  }
+
+  UNREACHABLE();
+  return Slice();
+}
+
+
+Coord Lines::IndexToCoord(size_t index) const {
+  ASSERT(index <= NODE_BYTES(root), OOPS);
+
+  // The index at the end of the buffer belongs to the last line.
+  if (index == NODE_BYTES(root)) {
+    int last = GetCount() - 1;
+    return Coord(last, (int) (index - Get(last).start));
+  }
+
+  int line = 0;
+  size_t start = 0; // The start index of the current subtree.
+
+  const Node* node = root.get();
+  while (node != nullptr) {
+    size_t left_bytes = NODE_BYTES(node->left);
+    size_t local = index - start;
+
+    if (local < left_bytes) {
+      node = node->left.get();
+
+    } else if (local < left_bytes + node->length) {
+      line += NODE_COUNT(node->left);
+      return Coord(line, (int) (local - left_bytes));
+
+    } else {
+      line  += NODE_COUNT(node->left) + 1;
+      start += left_bytes + node->length;
+      node = node->right.get();
+    }
+  }
+
+  UNREACHABLE();
+  return Coord();
+}
+
+
+void Lines::OnInsert(size_t index, const uint8_t* data, size_t length) {
+  if (length == 0) return;
+
+  // Length of each new line (including the new line character) in the inserted
+  // text. The last line of the text doesn't end with a new line.
+  //
+  //   text    = "foo\nbar\nbaz"
+  //   lengths = { 4, 4, 3 }
+  //
+  std::vector<uint32_t> lengths;
+  uint32_t curr = 0;
+  for (size_t i = 0; i < length; i++) {
+    curr++;
+    if (data[i] == '\n') {
+      lengths.push_back(curr);
+      curr = 0;
+    }
+  }
+  lengths.push_back(curr);
+
+  Coord coord = IndexToCoord(index);
+  uint32_t line = (uint32_t) coord.line;
+
+  // No new line is inserted, just the line grow.
+  if (lengths.size() == 1) {
+    AddLength(root.get(), line, (int64_t) length);
+    return;
+  }
+
+  // The line is split at the index, the head of the line takes the first
+  // line of the text and the tail goes with the last line of the text.
+  //
+  //   line = "hello world\n"
+  //   text = "foo\nbar"        (inserted at index 6)
+  //
+  //   "hello foo\n" "barworld\n"
+  //
+  uint32_t line_length = GetLength(root.get(), line);
+  uint32_t head = (uint32_t) coord.character;
+  uint32_t tail = line_length - head;
+
+  AddLength(root.get(), line, (int64_t) lengths[0] - (int64_t) tail);
+  lengths.erase(lengths.begin());
+  lengths.back() += tail;
+
+  std::unique_ptr<Node> left, right;
+  Split(std::move(root), line + 1, left, right);
+  left = Merge(std::move(left), BuildTree(lengths));
+  root = Merge(std::move(left), std::move(right));
+}
+
+
+void Lines::OnRemove(size_t index, size_t count) {
+  if (count == 0) return;
+
+  Coord start = IndexToCoord(index);
+  Coord end   = IndexToCoord(index + count);
+
+  // Removed within the same line.
+  if (start.line == end.line) {
+    AddLength(root.get(), start.line, -(int64_t) count);
+    return;
+  }
+
+  // The head of the start line and the tail of the end line are joined into a
+  // single line and all the lines between (and the end line) are removed.
+  uint32_t end_length = GetLength(root.get(), end.line);
+  uint32_t head = (uint32_t) start.character;
+  uint32_t tail = end_length - (uint32_t) end.character;
+  uint32_t start_length = GetLength(root.get(), start.line);
+
+  std::unique_ptr<Node> left, middle, right;
+  Split(std::move(root), start.line + 1, left, right);
+  Split(std::move(right), end.line - start.line, middle, right);
+  root = Merge(std::move(left), std::move(right));
+
+  AddLength(root.get(), start.line, (int64_t) (head + tail) - (int64_t) start_length);
+}
+
+
+std::unique_ptr<Lines::Node> Lines::NewNode(uint32_t length) {
+  // xorshift32 (https://en.wikipedia.org/wiki/Xorshift).
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+
+  std::unique_ptr<Node> node = std::make_unique<Node>();
+  node->length   = length;
+  node->priority = seed;
+  node->count    = 1;
+  node->bytes    = length;
+  return node;
+}
+
+
+std::unique_ptr<Lines::Node> Lines::BuildTree(const std::vector<uint32_t>& lengths) {
+
+  // Since the lines are already sorted, we can build the treap in O(n) with a
+  // stack of the right spine of the tree, where a node with higher priority
+  // takes the popped spine as it's left child.
+  //
+  // https://en.wikipedia.org/wiki/Cartesian_tree#Efficient_construction
+  std::unique_ptr<Node> tree;
+  std::vector<Node*> spine;
+
+  for (uint32_t length : lengths) {
+    std::unique_ptr<Node> node = NewNode(length);
+    Node* curr = node.get();
+
+    while (!spine.empty() && spine.back()->priority < curr->priority) {
+      spine.pop_back();
+    }
+
+    std::unique_ptr<Node>& slot = (spine.empty()) ? tree : spine.back()->right;
+    node->left = std::move(slot);
+    slot = std::move(node);
+    spine.push_back(curr);
+  }
+
+  UpdateAll(tree.get());
+  return tree;
+}
+
+
+void Lines::Update(Node* node) {
+  node->count = NODE_COUNT(node->left) + 1 + NODE_COUNT(node->right);
+  node->bytes = NODE_BYTES(node->left) + node->length + NODE_BYTES(node->right);
+}
+
+
+void Lines::UpdateAll(Node* node) {
+  if (node == nullptr) return;
+  UpdateAll(node->left.get());
+  UpdateAll(node->right.get());
+  Update(node);
+}
+
+
+void Lines::Split(std::unique_ptr<Node> node, uint32_t pos,
+                  std::unique_ptr<Node>& left, std::unique_ptr<Node>& right) {
+
+  if (node == nullptr) {
+    left  = nullptr;
+    right = nullptr;
+    return;
+  }
+
+  uint32_t left_count = NODE_COUNT(node->left);
+
+  if (pos <= left_count) {
+    std::unique_ptr<Node> node_left = std::move(node->left);
+    Split(std::move(node_left), pos, left, node->left);
+    Update(node.get());
+    right = std::move(node);
+
+  } else {
+    std::unique_ptr<Node> node_right = std::move(node->right);
+    Split(std::move(node_right), pos - left_count - 1, node->right, right);
+    Update(node.get());
+    left = std::move(node);
+  }
+}
+
+
+std::unique_ptr<Lines::Node> Lines::Merge(std::unique_ptr<Node> left, std::unique_ptr<Node> right) {
+  if (left == nullptr) return right;
+  if (right == nullptr) return left;
+
+  if (left->priority > right->priority) {
+    left->right = Merge(std::move(left->right), std::move(right));
+    Update(left.get());
+    return left;
+  }
+
+  right->left = Merge(std::move(left), std::move(right->left));
+  Update(right.get());
+  return right;
+}
+
+
+uint32_t Lines::GetLength(const Node* node, uint32_t line) {
+  while (node != nullptr) {
+    uint32_t left_count = NODE_COUNT(node->left);
+    if (line < left_count) {
+      node = node->left.get();
+    } else if (line == left_count) {
+      return node->length;
+    } else {
+      line -= left_count + 1;
+      node = node->right.get();
+    }
+  }
+  UNREACHABLE();
+  return 0;
+}
+
+
+void Lines::AddLength(Node* node, uint32_t line, int64_t delta) {
+  while (node != nullptr) {
+    node->bytes += delta;
+    uint32_t left_count = NODE_COUNT(node->left);
+    if (line < left_count) {
+      node = node->left.get();
+    } else if (line == left_count) {
+      node->length += delta;
+      return;
+    } else {
+      line -= left_count + 1;
+      node = node->right.get();
+    }
+  }
+  UNREACHABLE();
+}
@@ -0,0 +1,226 @@
+//
+// .--.--.--------.-----.----.-----. vmacs text editor and more.
+// |  |  |        |  _  |  __|__ --| version 0.1.0
+//  \___/|__|__|__|__.__|____|_____| https://github.com/thakeenathees/vmacs
+//
+// Copyright (c) 2024 Thakee Nathees
+// Licenced under: MIT
+
+#include "core/core.hpp"
+#include "document.hpp"
+
+
+#define NODE_SIZE(node) ((node) ? (node)->size : 0)
+
+
+PieceTable::PieceTable() {
+}
+
+
+PieceTable::PieceTable(std::vector<uint8_t>&& original) : original(std::move(original)) {
+  if (this->original.size() == 0) return;
+  root = NewNode({ false, 0, this->original.size() });
+}
+
+
+PieceTable::~PieceTable() {
+}
+
+
+size_t PieceTable::GetSize() const {
+  return NODE_SIZE(root);
+}
+
+
+uint8_t PieceTable::At(size_t index) const {
+  ASSERT_INDEX(index, GetSize());
+
+  if (cache_data != nullptr && BETWEEN(cache_index, index, cache_index + cache_length - 1)) {
+    return cache_data[index - cache_index];
+  }
+
+  size_t length;
+  const uint8_t* data = GetChunk(index, &length);
+  ASSERT(data != nullptr, OOPS);
+  return data[0];
+}
+
+
+const uint8_t* PieceTable::GetChunk(size_t index, size_t* length) const {
+  ASSERT(length != nullptr, OOPS);
+
+  if (index >= GetSize()) {
+    *length = 0;
+    return nullptr;
+  }
+
+  // The document index where the current subtree starts.
+  size_t offset = 0;
+
+  const Node* node = root.get();
+  while (node != nullptr) {
+    size_t left_size = NODE_SIZE(node->left);
+    size_t local = index - offset;
+
+    if (local < left_size) {
+      node = node->left.get();
+
+    } else if (local < left_size + node->piece.length) {
+      size_t piece_start = offset + left_size;
+      cache_index  = piece_start;
+      cache_length = node->piece.length;
+      cache_data   = PieceData(node->piece);
+
+      *length = cache_length - (index - piece_start);
+      return cache_data + (index - piece_start);
+
+    } else {
+      offset += left_size + node->piece.length;
+      node = node->right.get();
+    }
+  }
+
+  UNREACHABLE();
+  return nullptr;
+}
+
+
+void PieceTable::Insert(size_t index, const uint8_t* data, size_t length) {
+  ASSERT_INDEX(index, GetSize() + 1);
+  if (length == 0) return;
+
+  cache_data = nullptr;
+
+  size_t add_start = add.size();
+  add.insert(add.end(), data, data + length);
+
+  std::unique_ptr<Node> left, right;
+  Split(std::move(root), index, left, right);
+
+  if (!ExtendLast(left.get(), add_start, length)) {
+    left = Merge(std::move(left), NewNode({ true, add_start, length }));
+  }
+
+  root = Merge(std::move(left), std::move(right));
+}
+
+
+void PieceTable::Remove(size_t index, size_t count) {
+  if (count == 0) return;
+  ASSERT_INDEX(index, GetSize());
+  ASSERT_INDEX(index + (count-1), GetSize());
+
+  cache_data = nullptr;
+
+  std::unique_ptr<Node> left, middle, right;
+  Split(std::move(root), index, left, right);
+  Split(std::move(right), count, middle, right);
+
+  // The middle will be destroied here, note that the bytes are still in the
+  // original and add buffer (needed for undo anyways).
+  root = Merge(std::move(left), std::move(right));
+}
+
+
+const uint8_t* PieceTable::PieceData(const Piece& piece) const {
+  const std::vector<uint8_t>& source = (piece.added) ? add : original;
+  return source.data() + piece.start;
+}
+
+
+std::unique_ptr<PieceTable::Node> PieceTable::NewNode(const Piece& piece) {
+  // xorshift32 (https://en.wikipedia.org/wiki/Xorshift).
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+
+  std::unique_ptr<Node> node = std::make_unique<Node>();
+  node->piece    = piece;
+  node->priority = seed;
+  node->size     = piece.length;
+  return node;
+}
+
+
+void PieceTable::UpdateSize(Node* node) {
+  node->size = NODE_SIZE(node->left) + node->piece.length + NODE_SIZE(node->right);
+}
+
+
+void PieceTable::Split(std::unique_ptr<Node> node, size_t pos,
+                       std::unique_ptr<Node>& left, std::unique_ptr<Node>& right) {
+
+  if (node == nullptr) {
+    left  = nullptr;
+    right = nullptr;
+    return;
+  }
+
+  size_t left_size = NODE_SIZE(node->left);
+
+  if (pos <= left_size) {
+    std::unique_ptr<Node> node_left = std::move(node->left);
+    Split(std::move(node_left), pos, left, node->left);
+    UpdateSize(node.get());
+    right = std::move(node);
+
+  } else if (pos >= left_size + node->piece.length) {
+    std::unique_ptr<Node> node_right = std::move(node->right);
+    Split(std::move(node_right), pos - left_size - node->piece.length, node->right, right);
+    UpdateSize(node.get());
+    left = std::move(node);
+
+  } else {
+    // The position is at the middle of this piece, we cut the piece into two
+    // where the tail goes right with the right subtree. The tail will take the
+    // same priority so the heap property still holds on both sides.
+    size_t offset = pos - left_size;
+
+    std::unique_ptr<Node> tail = std::make_unique<Node>();
+    tail->piece.added  = node->piece.added;
+    tail->piece.start  = node->piece.start + offset;
+    tail->piece.length = node->piece.length - offset;
+    tail->priority     = node->priority;
+    tail->right        = std::move(node->right);
+    UpdateSize(tail.get());
+
+    node->piece.length = offset;
+    UpdateSize(node.get());
+
+    left  = std::move(node);
+    right = std::move(tail);
+  }
+}
+
+
+std::unique_ptr<PieceTable::Node> PieceTable::Merge(std::unique_ptr<Node> left, std::unique_ptr<Node> right) {
+  if (left == nullptr) return right;
+  if (right == nullptr) return left;
+
+  if (left->priority > right->priority) {
+    left->right = Merge(std::move(left->right), std::move(right));
+    UpdateSize(left.get());
+    return left;
+  }
+
+  right->left = Merge(std::move(left), std::move(right->left));
+  UpdateSize(right.get());
+  return right;
+}
+
+
+bool PieceTable::ExtendLast(Node* node, size_t add_start, size_t length) {
+  if (node == nullptr) return false;
+
+  if (node->right != nullptr) {
+    if (!ExtendLast(node->right.get(), add_start, length)) return false;
+    node->size += length;
+    return true;
+  }
+
+  Piece& piece = node->piece;
+  if (!piece.added || piece.start + piece.length != add_start) return false;
+  piece.length += length;
+  node->size   += length;
+  return true;
+}
@@ -20,6 +20,11 @@
 static bool TreeSitterCheckPredicate(const Buffer* buff, const TSQuery* query, TSQueryMatch match);
 
 
+// The TSInput read callback, returns the chunk of the buffer at the given byte
+// index. The payload is the buffer we're parsing.
+static const char* TreeSitterReadBuffer(void* payload, uint32_t byte_index, TSPoint position, uint32_t* bytes_read);
+
+
 Language::Language (Language&& other) {
   id               = other.id;
   query_highlight  = other.query_highlight;
@@ -47,23 +52,55 @@ const std::vector<Style>& Syntax::GetHighlights() const {
 }
 
 
+void Syntax::Edit(const std::vector<BufferChange>& changes) {
+  if (tree == NULL) return;
+
+  // Update the old tree with the changes, so the next parse will reuse the
+  // unchanged parts of it. Note that the changes should be applied in the same
+  // order as they're applied to the buffer.
+  for (const BufferChange& change : changes) {
+    TSInputEdit edit;
+    edit.start_byte     = (uint32_t) change.start;
+    edit.old_end_byte   = (uint32_t) change.old_end;
+    edit.new_end_byte   = (uint32_t) change.new_end;
+    edit.start_point    = { (uint32_t) change.start_coord.line,   (uint32_t) change.start_coord.character   };
+    edit.old_end_point  = { (uint32_t) change.old_end_coord.line, (uint32_t) change.old_end_coord.character };
+    edit.new_end_point  = { (uint32_t) change.new_end_coord.line, (uint32_t) change.new_end_coord.character };
+    ts_tree_edit(tree, &edit);
+  }
+}
+
+
 void Syntax::Parse(const Language* language, const Buffer* buffer, const Theme* theme) {
 
   if (language == nullptr) {
+    if (tree) ts_tree_delete(tree);
+    tree = NULL;
     slices.clear();
     return;
   }
 
   // Parse the source code.
   if (parser == NULL) parser = ts_parser_new();
-  ts_parser_set_language(parser, language->data);
 
-  // TODO: Use ts_tree_edit and pass old tree here to make the parsing much
-  // faster and efficient.
-  if (tree) ts_tree_delete(tree);
-  const char* cstr = reinterpret_cast<const char*>(buffer->GetData());
-  if (cstr == nullptr) cstr = ""; // If the buffer is empty will return nullptr.
-  tree = ts_parser_parse_string(parser, NULL, cstr, buffer->GetSize());
+  // If the language is changed, the old tree is useless and we parse from scratch.
+  if (ts_parser_language(parser) != language->data) {
+    if (tree) ts_tree_delete(tree);
+    tree = NULL;
+    ts_parser_set_language(parser, language->data);
+  }
+
+  // The buffer isn't contiguous in memory, so we feed the parser chunk by chunk.
+  TSInput input;
+  input.payload  = (void*) buffer;
+  input.read     = TreeSitterReadBuffer;
+  input.encoding = TSInputEncodingUTF8;
+
+  // The old tree (if any) is already edited with Edit() so the parser will only
+  // re-parse the changed regions of the buffer.
+  TSTree* old_tree = tree;
+  tree = ts_parser_parse(parser, old_tree, input);
+  if (old_tree) ts_tree_delete(old_tree);
 
   // Cache highlight slices.
   CacheHighlightSlices(language->query_highlight, buffer);
@@ -119,6 +156,16 @@ void Syntax::CacheHighlightSlices(const TSQuery* query, const Buffer* buffer) {
 }
 
 
+static const char* TreeSitterReadBuffer(void* payload, uint32_t byte_index, TSPoint position, uint32_t* bytes_read) {
+  const Buffer* buffer = static_cast<const Buffer*>(payload);
+  size_t length = 0;
+  const uint8_t* chunk = buffer->GetChunk(byte_index, &length);
+  *bytes_read = (uint32_t) length;
+  if (chunk == nullptr) return ""; // End of the buffer.
+  return reinterpret_cast<const char*>(chunk);
+}
+
+
 // The logic is stolen from: https://github.com/tree-sitter/tree-sitter/blob/a0cf0a7104f4a64eac04bd916297524db83d09c0/lib/binding_web/binding.js#L844
 static bool TreeSitterCheckPredicate(const Buffer* buff, const TSQuery* query, TSQueryMatch match) {
 